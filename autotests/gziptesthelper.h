@@ -0,0 +1,33 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#ifndef OKULAR_GZIPTESTHELPER_H
+#define OKULAR_GZIPTESTHELPER_H
+
+#include <QByteArray>
+
+#include <zlib.h>
+
+// Shared by the tests that need compressed V3D streams
+namespace GzipTestHelper
+{
+inline QByteArray gzip(const QByteArray &data)
+{
+    z_stream stream{};
+    // 15 window bits, +16 for a gzip wrapper
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+
+    QByteArray compressed(deflateBound(&stream, data.size()), Qt::Uninitialized);
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = data.size();
+    stream.next_out = reinterpret_cast<Bytef *>(compressed.data());
+    stream.avail_out = compressed.size();
+    deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return compressed;
+}
+}
+
+#endif // OKULAR_GZIPTESTHELPER_H
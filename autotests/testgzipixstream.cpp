@@ -0,0 +1,123 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "gzipixstream.h"
+#include <QBuffer>
+#include <QTest>
+#include <QtEndian>
+
+#include "gziptesthelper.h"
+
+// Tests reading XDR data through the streaming inflater.
+
+class GzipIxstreamTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testReadAcrossChunks();
+    void testSinkMatchesInflatedData();
+    void testTruncatedRead();
+    void testTruncatedDrain();
+
+private:
+    // Enough values for the inflated data to span several chunks
+    static constexpr quint32 valueCount = 5 * xdr::gzipixstream::chunkSize / sizeof(quint32) + 7;
+
+    static quint32 value(quint32 index);
+    static QByteArray xdrData();
+};
+
+quint32 GzipIxstreamTest::value(quint32 index)
+{
+    // Knuth's multiplicative hash, so the data does not compress to almost nothing
+    return index * 2654435761u;
+}
+
+QByteArray GzipIxstreamTest::xdrData()
+{
+    QByteArray data;
+    for (quint32 i = 0; i < valueCount; ++i) {
+        const quint32 bigEndian = qToBigEndian(value(i));
+        data.append(reinterpret_cast<const char *>(&bigEndian), sizeof(bigEndian));
+    }
+    return data;
+}
+
+void GzipIxstreamTest::testReadAcrossChunks()
+{
+    const QByteArray compressed = GzipTestHelper::gzip(xdrData());
+    xdr::gzipixstream stream{ compressed.constData(), static_cast<size_t>(compressed.size()) };
+
+    for (quint32 i = 0; i < valueCount; ++i) {
+        unsigned int read = 0;
+        stream >> read;
+        QVERIFY(!stream.fail());
+        QCOMPARE(read, value(i));
+    }
+
+    QVERIFY(stream.drain());
+    QVERIFY(!stream.bad());
+}
+
+void GzipIxstreamTest::testSinkMatchesInflatedData()
+{
+    const QByteArray data = xdrData();
+    const QByteArray compressed = GzipTestHelper::gzip(data);
+
+    QBuffer sink;
+    sink.open(QIODevice::WriteOnly);
+
+    xdr::gzipixstream stream{ compressed.constData(), static_cast<size_t>(compressed.size()), &sink };
+
+    // Only part of the data is read, drain has to deliver the rest to the sink
+    for (quint32 i = 0; i < 10; ++i) {
+        unsigned int read = 0;
+        stream >> read;
+        QCOMPARE(read, value(i));
+    }
+
+    QVERIFY(stream.drain());
+    QCOMPARE(sink.data().size(), data.size());
+    QVERIFY(sink.data() == data);
+}
+
+void GzipIxstreamTest::testTruncatedRead()
+{
+    const QByteArray compressed = GzipTestHelper::gzip(xdrData());
+    const QByteArray truncated = compressed.left(compressed.size() / 2);
+    xdr::gzipixstream stream{ truncated.constData(), static_cast<size_t>(truncated.size()) };
+
+    quint32 i = 0;
+    for (; i < valueCount; ++i) {
+        unsigned int read = 0;
+        stream >> read;
+        if (stream.fail()) {
+            break;
+        }
+        QCOMPARE(read, value(i));
+    }
+
+    QVERIFY(i < valueCount);
+    QVERIFY(stream.bad());
+    QVERIFY(!stream.drain());
+}
+
+void GzipIxstreamTest::testTruncatedDrain()
+{
+    const QByteArray compressed = GzipTestHelper::gzip(xdrData());
+    const QByteArray truncated = compressed.left(compressed.size() - 100);
+
+    QBuffer sink;
+    sink.open(QIODevice::WriteOnly);
+
+    xdr::gzipixstream stream{ truncated.constData(), static_cast<size_t>(truncated.size()), &sink };
+
+    QVERIFY(!stream.drain());
+    QVERIFY(stream.bad());
+}
+
+QTEST_MAIN(GzipIxstreamTest)
+#include "testgzipixstream.moc"
+
+// No need to export it, but we need to be able to call the functions
+#include "gzipixstream.cpp"
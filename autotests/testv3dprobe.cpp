@@ -0,0 +1,150 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "v3dprobe.h"
+#include <QTest>
+#include <QtEndian>
+
+#include "gziptesthelper.h"
+
+#include <cstring>
+
+// Tests recognizing V3D assets from the start of the compressed stream.
+
+class V3dProbeTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testDoublePrecisionHeader();
+    void testSinglePrecisionHeader();
+    void testNoHeader();
+    void testTruncatedHeader();
+    void testNotV3d();
+    void testNotCompressed();
+
+private:
+    static void appendUint(QByteArray &data, quint32 value);
+    static void appendDouble(QByteArray &data, double value);
+    static void appendFloat(QByteArray &data, float value);
+};
+
+void V3dProbeTest::appendUint(QByteArray &data, quint32 value)
+{
+    const quint32 bigEndian = qToBigEndian(value);
+    data.append(reinterpret_cast<const char *>(&bigEndian), sizeof(bigEndian));
+}
+
+void V3dProbeTest::appendDouble(QByteArray &data, double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits = qToBigEndian(bits);
+    data.append(reinterpret_cast<const char *>(&bits), sizeof(bits));
+}
+
+void V3dProbeTest::appendFloat(QByteArray &data, float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendUint(data, bits);
+}
+
+void V3dProbeTest::testDoublePrecisionHeader()
+{
+    QByteArray data;
+    appendUint(data, 1); // version
+    appendUint(data, 1); // double precision
+    appendUint(data, 5); // header
+    appendUint(data, 4); // header count
+    appendUint(data, 1); // canvasWidth
+    appendUint(data, 1);
+    appendUint(data, 400);
+    appendUint(data, 7); // angleOfView, skipped
+    appendUint(data, 2);
+    appendDouble(data, 30.0);
+    appendUint(data, 4); // minBound
+    appendUint(data, 6);
+    appendDouble(data, -1.0);
+    appendDouble(data, -2.0);
+    appendDouble(data, -3.0);
+    appendUint(data, 5); // maxBound
+    appendUint(data, 6);
+    appendDouble(data, 1.0);
+    appendDouble(data, 2.0);
+    appendDouble(data, 3.0);
+    data.append(QByteArray(4800, '\0')); // body
+
+    const V3dProbe probe = V3dProbe::Probe(GzipTestHelper::gzip(data));
+    QVERIFY(probe.valid);
+    QCOMPARE(probe.uncompressedSize, quint64(data.size()));
+}
+
+void V3dProbeTest::testSinglePrecisionHeader()
+{
+    QByteArray data;
+    appendUint(data, 1);
+    appendUint(data, 0);
+    appendUint(data, 5);
+    appendUint(data, 2);
+    appendUint(data, 4);
+    appendUint(data, 3);
+    appendFloat(data, 0.5f);
+    appendFloat(data, 0.25f);
+    appendFloat(data, 0.125f);
+    appendUint(data, 5);
+    appendUint(data, 3);
+    appendFloat(data, 4.0f);
+    appendFloat(data, 5.0f);
+    appendFloat(data, 6.0f);
+
+    const V3dProbe probe = V3dProbe::Probe(GzipTestHelper::gzip(data));
+    QVERIFY(probe.valid);
+}
+
+void V3dProbeTest::testNoHeader()
+{
+    QByteArray data;
+    appendUint(data, 1);
+    appendUint(data, 1);
+    appendUint(data, 130); // bezierPatch
+
+    const V3dProbe probe = V3dProbe::Probe(GzipTestHelper::gzip(data));
+    QVERIFY(!probe.valid);
+}
+
+void V3dProbeTest::testTruncatedHeader()
+{
+    QByteArray data;
+    appendUint(data, 1);
+    appendUint(data, 1);
+    appendUint(data, 5);
+    appendUint(data, 3); // header count, only one entry follows
+    appendUint(data, 1);
+    appendUint(data, 1);
+    appendUint(data, 400);
+
+    const V3dProbe probe = V3dProbe::Probe(GzipTestHelper::gzip(data));
+    QVERIFY(!probe.valid);
+}
+
+void V3dProbeTest::testNotV3d()
+{
+    const V3dProbe probe = V3dProbe::Probe(GzipTestHelper::gzip(QByteArrayLiteral("RIFF\x10\0\0\0WEBPVP8 ")));
+    QVERIFY(!probe.valid);
+}
+
+void V3dProbeTest::testNotCompressed()
+{
+    QByteArray data;
+    appendUint(data, 1);
+    appendUint(data, 1);
+
+    const V3dProbe probe = V3dProbe::Probe(data);
+    QVERIFY(!probe.valid);
+}
+
+QTEST_MAIN(V3dProbeTest)
+#include "testv3dprobe.moc"
+
+// No need to export it, but we need to be able to call the functions
+#include "v3dprobe.cpp"
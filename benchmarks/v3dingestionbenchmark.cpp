@@ -0,0 +1,328 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+// Measures how long each stage of getting a V3D model from a PDF onto the
+// screen takes, over a directory of PDFs and .v3d files, and prints the
+// results as JSON so runs can be diffed.
+//
+// Assets go through the same path as in the generator: streaming inflate and
+// the disk cache. "parse" is a disk cache miss, which inflates the asset and
+// writes the cache entry, "cachedParse" is the following hit. Tessellation
+// happens inside the V3dModel constructor, so it is part of both. Pages
+// without assets are timed separately as "extractEmptyPages".
+
+#include <QCommandLineParser>
+#include <QCryptographicHash>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <poppler-qt5.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "V3dModelManager.h"
+#include "debug_pdf.h"
+#include "v3ddiskcache.h"
+#include "v3dprobe.h"
+
+// Normally defined by generator_pdf.cpp, the disk cache logs to it
+Q_LOGGING_CATEGORY(OkularPdfDebug, "org.kde.okular.generators.pdf", QtWarningMsg)
+
+namespace
+{
+struct Sample {
+    qint64 nanoseconds{ 0 };
+    qint64 peakRssKiB{ 0 };
+    qint64 peakRssGrowthKiB{ 0 };
+};
+
+struct Stage {
+    void Add(const Sample &sample)
+    {
+        nanoseconds.push_back(sample.nanoseconds);
+        peakRssKiB = std::max(peakRssKiB, sample.peakRssKiB);
+        peakRssGrowthKiB = std::max(peakRssGrowthKiB, sample.peakRssGrowthKiB);
+    }
+
+    std::vector<qint64> nanoseconds;
+    qint64 peakRssKiB{ 0 };
+    qint64 peakRssGrowthKiB{ 0 };
+};
+
+// A field of /proc/self/status, in KiB
+qint64 statusKiB(const QByteArray &field)
+{
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (!status.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith(field + ':')) {
+            return line.mid(field.size() + 1).trimmed().split(' ').constFirst().toLongLong();
+        }
+    }
+    return 0;
+}
+
+// Resets VmHWM to the current resident set, so the next read covers only what ran since
+void resetPeakResident()
+{
+    QFile clearRefs(QStringLiteral("/proc/self/clear_refs"));
+    if (clearRefs.open(QIODevice::WriteOnly)) {
+        clearRefs.write("5");
+    }
+}
+
+// Runs one sample of a stage, recording its duration and the peak resident set while it ran
+Sample measure(const std::function<void()> &function)
+{
+    resetPeakResident();
+    const qint64 rssBefore = statusKiB("VmRSS");
+    QElapsedTimer timer;
+    timer.start();
+
+    function();
+
+    Sample sample;
+    sample.nanoseconds = timer.nsecsElapsed();
+    sample.peakRssKiB = statusKiB("VmHWM");
+    sample.peakRssGrowthKiB = std::max<qint64>(0, sample.peakRssKiB - rssBefore);
+    return sample;
+}
+
+double percentileMs(std::vector<qint64> sorted, double percentile)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(percentile * (sorted.size() - 1) + 0.5));
+    return sorted[index] / 1e6;
+}
+
+QJsonObject toJson(const Stage &stage)
+{
+    QJsonObject object;
+    object[QStringLiteral("samples")] = static_cast<qint64>(stage.nanoseconds.size());
+    object[QStringLiteral("minMs")] = percentileMs(stage.nanoseconds, 0.0);
+    object[QStringLiteral("medianMs")] = percentileMs(stage.nanoseconds, 0.5);
+    object[QStringLiteral("p99Ms")] = percentileMs(stage.nanoseconds, 0.99);
+    object[QStringLiteral("peakRssKiB")] = stage.peakRssKiB;
+    object[QStringLiteral("peakRssGrowthKiB")] = stage.peakRssGrowthKiB;
+    return object;
+}
+
+class Benchmark
+{
+public:
+    Benchmark(const QString &shaderPath, bool render, int renderSize, qint64 diskCacheSize)
+        : shaderPath(shaderPath)
+        , render(render)
+        , renderSize(renderSize)
+        , diskCacheSize(diskCacheSize)
+    {
+    }
+
+    void RunPdf(const QString &path)
+    {
+        std::unique_ptr<Poppler::Document> document{ Poppler::Document::load(path) };
+        if (!document || document->isLocked()) {
+            qWarning() << "Could not open" << path;
+            return;
+        }
+
+        std::vector<QByteArray> assets;
+        for (int i = 0; i < document->numPages(); ++i) {
+            std::unique_ptr<Poppler::Page> page{ document->page(i) };
+            if (!page) {
+                continue;
+            }
+
+            const size_t assetsBefore = assets.size();
+            const Sample sample = measure([&]() {
+                const QList<Poppler::Annotation *> annotations = page->annotations({ Poppler::Annotation::ARichMedia });
+                for (Poppler::Annotation *annotation : annotations) {
+                    auto *richMedia = static_cast<Poppler::RichMediaAnnotation *>(annotation);
+                    if (richMedia->content() != nullptr) {
+                        for (Poppler::RichMediaAnnotation::Asset *asset : richMedia->content()->assets()) {
+                            if (asset != nullptr && asset->embeddedFile() != nullptr) {
+                                assets.push_back(asset->embeddedFile()->data());
+                            }
+                        }
+                    }
+                }
+                qDeleteAll(annotations);
+            });
+            stages[assets.size() > assetsBefore ? "extract" : "extractEmptyPages"].Add(sample);
+        }
+
+        RunAssets(assets);
+    }
+
+    void RunV3d(const QString &path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "Could not open" << path;
+            return;
+        }
+
+        RunAssets({ file.readAll() });
+    }
+
+    QJsonObject Results() const
+    {
+        QJsonObject results;
+        for (const auto &[name, stage] : stages) {
+            results[QString::fromStdString(name)] = toJson(stage);
+        }
+        return results;
+    }
+
+    int Failures() const
+    {
+        return failures;
+    }
+
+    int SkippedAssets() const
+    {
+        return skippedAssets;
+    }
+
+private:
+    void RunAssets(const std::vector<QByteArray> &assets)
+    {
+        // One manager per input file, so the first render of a file includes the renderer setup
+        std::unique_ptr<V3dModelManager> modelManager;
+        if (render) {
+            modelManager = std::make_unique<V3dModelManager>(nullptr, shaderPath.toStdString());
+        }
+
+        // A fresh disk cache per input file, so "parse" is always a miss
+        QTemporaryDir cacheDirectory;
+        V3dDiskCache diskCache(cacheDirectory.path());
+        diskCache.SetMaxSize(diskCacheSize);
+
+        // Like the generator, identical assets within a file are only parsed once
+        std::set<std::string> seen;
+
+        int modelIndex = 0;
+        for (const QByteArray &asset : assets) {
+            // The same key as V3dAssetStore::ContentHash
+            const std::string contentHash = QCryptographicHash::hash(asset, QCryptographicHash::Sha256).toStdString();
+            if (!seen.insert(contentHash).second) {
+                continue;
+            }
+
+            const V3dProbe probe = V3dProbe::Probe(asset);
+            if (!probe.valid) {
+                ++skippedAssets;
+                continue;
+            }
+
+            try {
+                std::unique_ptr<V3dModel> model;
+                stages["parse"].Add(measure([&]() { model = diskCache.Parse(contentHash, asset, probe.uncompressedSize); }));
+
+                // Assets larger than the cache are not stored, a second parse would be another miss
+                if (diskCache.Stores(probe.uncompressedSize)) {
+                    model.reset();
+                    stages["cachedParse"].Add(measure([&]() { model = diskCache.Parse(contentHash, asset, probe.uncompressedSize); }));
+                }
+
+                if (modelManager) {
+                    model->minBound = glm::vec2{ 0.0f, 0.0f };
+                    model->maxBound = glm::vec2{ 1.0f, 1.0f };
+                    modelManager->AddModel(std::move(*model), 0);
+                    const int index = modelIndex++;
+                    stages["render"].Add(measure([&]() { modelManager->RenderModel(0, index, renderSize, renderSize); }));
+                }
+            } catch (const std::exception &e) {
+                qWarning() << "Failed to ingest a V3D asset:" << e.what();
+                ++failures;
+            }
+        }
+    }
+
+    QString shaderPath;
+    bool render;
+    int renderSize;
+    qint64 diskCacheSize;
+    std::map<std::string, Stage> stages;
+    int failures{ 0 };
+    int skippedAssets{ 0 };
+};
+}
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("v3dingestionbenchmark"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Times the V3D ingestion stages over a directory of PDF and .v3d files"));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("directory"), QStringLiteral("Directory holding the PDF and .v3d files"));
+    parser.addOption({ QStringLiteral("shaders"), QStringLiteral("Directory holding the compiled V3D shaders"), QStringLiteral("path") });
+    parser.addOption({ QStringLiteral("no-render"), QStringLiteral("Skip the RenderModel stage") });
+    parser.addOption({ QStringLiteral("size"), QStringLiteral("Edge length of the rendered image, in pixels"), QStringLiteral("pixels"), QStringLiteral("512") });
+    parser.addOption({ QStringLiteral("repeat"), QStringLiteral("Number of passes over the directory"), QStringLiteral("count"), QStringLiteral("1") });
+    parser.addOption({ QStringLiteral("disk-cache-size"), QStringLiteral("Size limit of the disk cache in MiB, 0 disables it"), QStringLiteral("MiB"), QStringLiteral("512") });
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+
+    const bool render = !parser.isSet(QStringLiteral("no-render"));
+    if (render && !parser.isSet(QStringLiteral("shaders"))) {
+        qWarning() << "--shaders is required unless --no-render is given";
+        return 1;
+    }
+
+    const QDir directory(parser.positionalArguments().constFirst());
+    const QFileInfoList files = directory.entryInfoList({ QStringLiteral("*.pdf"), QStringLiteral("*.v3d") }, QDir::Files, QDir::Name);
+
+    const qint64 diskCacheSize = parser.value(QStringLiteral("disk-cache-size")).toLongLong() * 1024 * 1024;
+    Benchmark benchmark(parser.value(QStringLiteral("shaders")) + QLatin1Char('/'), render, parser.value(QStringLiteral("size")).toInt(), diskCacheSize);
+
+    const int repeat = std::max(1, parser.value(QStringLiteral("repeat")).toInt());
+    for (int pass = 0; pass < repeat; ++pass) {
+        for (const QFileInfo &file : files) {
+            if (file.suffix().compare(QLatin1String("pdf"), Qt::CaseInsensitive) == 0) {
+                benchmark.RunPdf(file.filePath());
+            } else {
+                benchmark.RunV3d(file.filePath());
+            }
+        }
+    }
+
+    QJsonObject output;
+    output[QStringLiteral("files")] = files.size();
+    output[QStringLiteral("passes")] = repeat;
+    output[QStringLiteral("failures")] = benchmark.Failures();
+    output[QStringLiteral("skippedAssets")] = benchmark.SkippedAssets();
+    output[QStringLiteral("stages")] = benchmark.Results();
+
+    std::fputs(QJsonDocument(output).toJson().constData(), stdout);
+
+    return 0;
+}
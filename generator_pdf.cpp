@@ -642,7 +642,11 @@ static void PDFGeneratorPopplerDebugFunction(const QString &message, const QVari
 }
 
 // ==================================== Custom Addition ====================================
-void PDFGenerator::CustomConstructor() { }
+void PDFGenerator::CustomConstructor()
+{
+    assetStore.SetDiskCacheSize(qint64(PDFSettings::v3dDiskCacheSize()) * 1024 * 1024);
+    V3dModelCache::Instance().SetMemoryBudget(qint64(PDFSettings::v3dMemoryBudget()) * 1024 * 1024);
+}
 
 void PDFGenerator::CustomDestructor() { }
 
@@ -771,6 +775,8 @@ Okular::Document::OpenResult PDFGenerator::init(QVector<Okular::Page *> &pagesVe
 
     loadPages(pagesVector, 0, false);
 
+    assetStore.ParseInBackground();
+
     // update the configuration
     reparseConfig();
 
@@ -827,6 +833,7 @@ bool PDFGenerator::doCloseDocument()
     docEmbeddedFiles.clear();
     nextFontPage = 0;
     rectsGenerated.clear();
+    assetStore.Clear();
 
     return true;
 }
@@ -868,6 +875,8 @@ void PDFGenerator::loadPages(QVector<Okular::Page *> &pagesVector, int rotation,
             if (true) { // TODO real check
                 addAnnotations(p, page);
             }
+            // Custom
+            addV3dAssets(p, page);
             Poppler::Link *tmplink = p->action(Poppler::Page::Opening);
             if (tmplink) {
                 page->setPageAction(Okular::Page::Opening, createLinkFromPopplerLink(tmplink));
@@ -1284,36 +1293,82 @@ QImage PDFGenerator::image(Okular::PixmapRequest *request)
         resolveMediaLinkReferences(page);
     }
 
+    // 3. UNLOCK [re-enables shared access]
+    userMutex()->unlock();
+
     // Custom
-    if (!img.isNull() && img.format() != QImage::Format_Mono && !modelManager.Empty()) {
+    // Parsing a large model can take seconds, so only that happens without holding userMutex.
+    // The model manager is shared with the GUI thread and only used with the lock held
+    if (!img.isNull() && img.format() != QImage::Format_Mono) {
         size_t pageNumber = (size_t)request->page()->number();
 
-        int i = 0;
-        for (auto& model : modelManager.Models(pageNumber)) {
-            int xMin = (int)(request->width() * model.minBound.x);
-            int xMax = (int)(request->width() * model.maxBound.x);
-            int yMin = (int)(request->height() * model.minBound.y);
-            int yMax = (int)(request->height() * model.maxBound.y);
-            
-            int imageWidth = xMax - xMin;
-            int imageHeight = yMax - yMin;
+        // Each model is drawn once, as soon as the manager has it. Expects userMutex to be held
+        size_t drawnModels = 0;
+        auto drawNewModels = [&]() {
+            if (modelManager.Empty()) {
+                return;
+            }
 
-            QImage image = modelManager.RenderModel(pageNumber, i, imageWidth, imageHeight);
+            const auto& models = modelManager.Models(pageNumber);
+            for (; drawnModels < models.size(); ++drawnModels) {
+                const auto& model = models[drawnModels];
 
-            QPainter painter{ &img };
+                // Models entirely outside of the tile would only be rendered to be clipped away
+                if (isTile && !request->normalizedRect().intersects(Okular::NormalizedRect(model.minBound.x, model.minBound.y, model.maxBound.x, model.maxBound.y))) {
+                    continue;
+                }
 
-            if (isTile) {
-                painter.drawImage(xMin - request->normalizedRect().left * request->width(), yMin - request->normalizedRect().top * request->height(), image);
-            } else {
-                painter.drawImage(xMin, yMin, image);
+                int xMin = (int)(request->width() * model.minBound.x);
+                int xMax = (int)(request->width() * model.maxBound.x);
+                int yMin = (int)(request->height() * model.minBound.y);
+                int yMax = (int)(request->height() * model.maxBound.y);
+
+                int imageWidth = xMax - xMin;
+                int imageHeight = yMax - yMin;
+
+                QImage image = modelManager.RenderModel(pageNumber, (int)drawnModels, imageWidth, imageHeight);
+
+                QPainter painter{ &img };
+
+                if (isTile) {
+                    painter.drawImage(xMin - request->normalizedRect().left * request->width(), yMin - request->normalizedRect().top * request->height(), image);
+                } else {
+                    painter.drawImage(xMin, yMin, image);
+                }
             }
+        };
 
-            ++i;
+        // Models parsed by an earlier request for this page
+        {
+            QMutexLocker ml(userMutex());
+            drawNewModels();
         }
-    }
 
-    // 3. UNLOCK [re-enables shared access]
-    userMutex()->unlock();
+        // Show the page itself right away, a single large model can take seconds to parse
+        if (assetStore.PendingModels(pageNumber) > 0 && request->partialUpdatesWanted() && !request->shouldAbortRender()) {
+            // clang-format off
+            QMetaObject::invokeMethod(this, "signalPartialPixmapRequest", Qt::QueuedConnection, Q_ARG(Okular::PixmapRequest*, request), Q_ARG(QImage, img.copy()));
+            // clang-format on
+        }
+
+        auto shouldAbort = [request]() { return request->shouldAbortRender(); };
+        assetStore.LoadPage(pageNumber, shouldAbort, [&](std::unique_ptr<V3dModel> model, int remainingModels) {
+            {
+                QMutexLocker ml(userMutex());
+                if (model != nullptr) {
+                    modelManager.AddModel(std::move(*model), pageNumber);
+                }
+                drawNewModels();
+            }
+
+            // Show what is there so far while the rest of the page's models are still being parsed
+            if (remainingModels > 0 && request->partialUpdatesWanted() && !request->shouldAbortRender()) {
+                // clang-format off
+                QMetaObject::invokeMethod(this, "signalPartialPixmapRequest", Qt::QueuedConnection, Q_ARG(Okular::PixmapRequest*, request), Q_ARG(QImage, img.copy()));
+                // clang-format on
+            }
+        });
+    }
 
     delete p;
 
@@ -1856,59 +1911,49 @@ void PDFGenerator::addSynopsisChildren(const QVector<Poppler::OutlineItem> &outl
     }
 }
 
-void PDFGenerator::addAnnotations(Poppler::Page *popplerPage, Okular::Page *page)
+void PDFGenerator::addV3dAssets(Poppler::Page *popplerPage, Okular::Page *page)
 {
-    QSet<Poppler::Annotation::SubType> subtypes;
-    subtypes << Poppler::Annotation::AFileAttachment << Poppler::Annotation::ASound << Poppler::Annotation::AMovie << Poppler::Annotation::AWidget << Poppler::Annotation::AScreen << Poppler::Annotation::AText << Poppler::Annotation::ALine
-             << Poppler::Annotation::AGeom << Poppler::Annotation::AHighlight << Poppler::Annotation::AInk << Poppler::Annotation::AStamp << Poppler::Annotation::ACaret;
+    // Only RichMedia annotations are materialized here, the rest of the page's annotations are left to addAnnotations
+    const QList<Poppler::Annotation *> richMediaAnnotations = popplerPage->annotations({ Poppler::Annotation::ARichMedia });
 
-    const QList<Poppler::Annotation *> popplerAnnotations = popplerPage->annotations(subtypes);
+    for (Poppler::Annotation *a : richMediaAnnotations) {
+        QRectF bound = a->boundary();
+        bound = bound.normalized();
 
-    for (Poppler::Annotation *a : popplerAnnotations) {
-        // ============== Custom ==============
-        if (a->subType() == Poppler::Annotation::SubType::ARichMedia) {
-            QRectF bound = a->boundary();
-            bound = bound.normalized();
-
-            Poppler::RichMediaAnnotation* richMedia = dynamic_cast<Poppler::RichMediaAnnotation*>(a);
-            if (richMedia == nullptr) {
-                continue;
-            }
-
-            Poppler::RichMediaAnnotation::Content* content = richMedia->content();
-            if (content == nullptr) {
-                continue;
-            }
+        Poppler::RichMediaAnnotation *richMedia = static_cast<Poppler::RichMediaAnnotation *>(a);
 
-            QList<Poppler::RichMediaAnnotation::Asset*> assets = content->assets();
+        Poppler::RichMediaAnnotation::Content *content = richMedia->content();
+        if (content != nullptr) {
+            const QList<Poppler::RichMediaAnnotation::Asset *> assets = content->assets();
 
-            for (Poppler::RichMediaAnnotation::Asset* asset : assets) {
+            for (Poppler::RichMediaAnnotation::Asset *asset : assets) {
                 if (asset == nullptr) {
                     continue;
                 }
-                
-                Poppler::EmbeddedFile* embeddedFile = asset->embeddedFile();
+
+                Poppler::EmbeddedFile *embeddedFile = asset->embeddedFile();
                 if (embeddedFile == nullptr) {
                     continue;
                 }
 
-                QByteArray fileData = embeddedFile->data();
-
-                std::string decompressedData = gzip::decompress(fileData.data(), fileData.size());
-
-                xdr::memixstream xdrFile{ decompressedData.data(), decompressedData.size() };
+                // The model itself is only parsed later, see V3dAssetStore
+                assetStore.AddAsset(page->number(), embeddedFile->data(), bound);
+            }
+        }
 
-                QRectF bound = a->boundary();
-                bound = bound.normalized();
+        delete a;
+    }
+}
 
-                glm::vec2 minBound{ bound.left(), bound.top() };
-                glm::vec2 maxBound{ bound.right(), bound.bottom() };
+void PDFGenerator::addAnnotations(Poppler::Page *popplerPage, Okular::Page *page)
+{
+    QSet<Poppler::Annotation::SubType> subtypes;
+    subtypes << Poppler::Annotation::AFileAttachment << Poppler::Annotation::ASound << Poppler::Annotation::AMovie << Poppler::Annotation::AWidget << Poppler::Annotation::AScreen << Poppler::Annotation::AText << Poppler::Annotation::ALine
+             << Poppler::Annotation::AGeom << Poppler::Annotation::AHighlight << Poppler::Annotation::AInk << Poppler::Annotation::AStamp << Poppler::Annotation::ACaret;
 
-                modelManager.AddModel(V3dModel{ xdrFile, minBound, maxBound }, page->number());         
-            }    
-        }
-        // ============== End Custom ==============
+    const QList<Poppler::Annotation *> popplerAnnotations = popplerPage->annotations(subtypes);
 
+    for (Poppler::Annotation *a : popplerAnnotations) {
         bool doDelete = true;
         Okular::Annotation *newann = createAnnotationFromPopplerAnnotation(a, *popplerPage, &doDelete);
         if (newann) {
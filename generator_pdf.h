@@ -54,6 +54,7 @@
 #include <glm/gtx/string_cast.hpp>
 
 #include "V3dModelManager.h"
+#include "v3dassetstore.h"
 
 class PDFOptionsPage;
 class PopplerAnnotationProxy;
@@ -82,11 +83,15 @@ class PDFGenerator : public Okular::Generator, public Okular::ConfigInterface, p
 public:
     V3dModelManager modelManager{ document(), "/home/benjaminb/kde/src/okular/generators/Okular-v3d-Embeded-Plugin-Code/3rdParty/V3D-Common/shaders/" };
     //V3dModelManager modelManager{ document(), "" };
+    V3dAssetStore assetStore;
 
 private:
     void CustomConstructor();
     void CustomDestructor();
 
+    // index the V3D assets of the page's RichMedia annotations, without materializing its other annotations
+    void addV3dAssets(Poppler::Page *popplerPage, Okular::Page *page);
+
 // ================================= End of Custom Addition =================================
 
 public:
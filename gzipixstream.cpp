@@ -0,0 +1,121 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "gzipixstream.h"
+
+#include <QIODevice>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <vector>
+
+namespace xdr
+{
+// Owned by the FILE cookie, released when the stream's FILE is closed
+struct Inflater {
+    z_stream stream{};
+    // Gets badbit once inflating fails
+    gzipixstream *owner{ nullptr };
+    QIODevice *sink{ nullptr };
+    bool finished{ false };
+    bool sinkFailed{ false };
+};
+}
+
+namespace
+{
+ssize_t inflaterRead(void *cookie, char *buffer, size_t size)
+{
+    auto *inflater = static_cast<xdr::Inflater *>(cookie);
+    z_stream &stream = inflater->stream;
+
+    stream.next_out = reinterpret_cast<Bytef *>(buffer);
+    stream.avail_out = static_cast<uInt>(std::min<size_t>(size, UINT_MAX));
+    const uInt requested = stream.avail_out;
+
+    while (stream.avail_out > 0 && !inflater->finished) {
+        const int ret = inflate(&stream, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            inflater->finished = true;
+        } else if (ret != Z_OK) {
+            // Truncated or corrupt input, hand out what we have. The stream is marked bad right away so the
+            // reader does not take the end of the data for a complete model
+            inflater->finished = true;
+            inflater->owner->set(xdr::gzipixstream::badbit);
+            if (stream.avail_out == requested) {
+                return -1;
+            }
+        }
+    }
+
+    const ssize_t produced = requested - stream.avail_out;
+    if (inflater->sink != nullptr && produced > 0 && inflater->sink->write(buffer, produced) != produced) {
+        inflater->sinkFailed = true;
+    }
+
+    return produced;
+}
+
+int inflaterClose(void *cookie)
+{
+    auto *inflater = static_cast<xdr::Inflater *>(cookie);
+    inflateEnd(&inflater->stream);
+    delete inflater;
+    return 0;
+}
+}
+
+namespace xdr
+{
+gzipixstream::gzipixstream(const char *data, size_t length, QIODevice *sink, bool singleprecision)
+    : ixstream(singleprecision)
+{
+    auto *newInflater = new Inflater;
+    newInflater->stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    newInflater->stream.avail_in = static_cast<uInt>(length);
+    newInflater->owner = this;
+    newInflater->sink = sink;
+
+    // 15 window bits, +32 to detect gzip or zlib headers, the same as gzip::decompress
+    if (inflateInit2(&newInflater->stream, 15 + 32) != Z_OK) {
+        delete newInflater;
+        set(badbit);
+        return;
+    }
+
+    cookie_io_functions_t functions{};
+    functions.read = inflaterRead;
+    functions.close = inflaterClose;
+
+    buf = fopencookie(newInflater, "r", functions);
+    if (buf == nullptr) {
+        inflaterClose(newInflater);
+        set(badbit);
+        return;
+    }
+
+    inflater = newInflater;
+    setvbuf(buf, nullptr, _IOFBF, chunkSize);
+    xdrstdio_create(&xdri, buf, XDR_DECODE);
+}
+
+bool gzipixstream::drain()
+{
+    if (inflater == nullptr) {
+        return false;
+    }
+
+    std::vector<char> scratch(chunkSize);
+    while (!inflater->finished) {
+        if (inflaterRead(inflater, scratch.data(), scratch.size()) < 0) {
+            break;
+        }
+    }
+
+    return !bad() && !inflater->sinkFailed;
+}
+}
@@ -0,0 +1,47 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef OKULAR_GZIPIXSTREAM_H
+#define OKULAR_GZIPIXSTREAM_H
+
+#include <cstddef>
+
+#include "V3dModel.h"
+
+class QIODevice;
+
+namespace xdr
+{
+struct Inflater;
+
+/**
+ * An XDR input stream over gzip compressed data.
+ *
+ * Unlike inflating the whole buffer and wrapping it in a memixstream, the
+ * data is inflated in fixed-size chunks as the XDR reader consumes it, so only
+ * the compressed input and a small window are resident while a model is parsed.
+ * The compressed data must outlive the stream.
+ *
+ * If a sink is given every inflated chunk is also written to it.
+ *
+ * Corrupt or truncated compressed data sets badbit on the stream as soon as
+ * inflating fails, so a reader can tell an error from the end of the data.
+ */
+class gzipixstream : public ixstream
+{
+public:
+    static constexpr size_t chunkSize = 64 * 1024;
+
+    gzipixstream(const char *data, size_t length, QIODevice *sink = nullptr, bool singleprecision = false);
+
+    // Inflates whatever the XDR reader did not consume, so the sink holds the complete stream.
+    // Returns false if the compressed data is corrupt or truncated, or could not be written to the sink
+    bool drain();
+
+private:
+    Inflater *inflater{ nullptr };
+};
+}
+
+#endif // OKULAR_GZIPIXSTREAM_H
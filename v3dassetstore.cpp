@@ -0,0 +1,251 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "v3dassetstore.h"
+
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <map>
+
+#include "debug_pdf.h"
+
+namespace
+{
+class ParseTask : public QRunnable
+{
+public:
+    explicit ParseTask(std::packaged_task<bool()> task)
+        : task(std::move(task))
+    {
+        setAutoDelete(false);
+    }
+
+    void run() override
+    {
+        task();
+    }
+
+private:
+    std::packaged_task<bool()> task;
+};
+
+// Shared by every open document, so opening several of them does not oversubscribe the CPU
+class ParsePool : public QThreadPool
+{
+public:
+    ParsePool()
+    {
+        // Leave a core for the GUI and the renderer
+        setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+    }
+};
+
+Q_GLOBAL_STATIC(ParsePool, parsePool)
+}
+
+V3dAssetStore::~V3dAssetStore()
+{
+    Clear();
+}
+
+std::string V3dAssetStore::ContentHash(const QByteArray& compressedData)
+{
+    return QCryptographicHash::hash(compressedData, QCryptographicHash::Sha256).toStdString();
+}
+
+void V3dAssetStore::SetDiskCacheSize(qint64 bytes)
+{
+    diskCache.SetMaxSize(bytes);
+}
+
+void V3dAssetStore::AddAsset(int pageNumber, const QByteArray& compressedData, const QRectF& bound)
+{
+    Asset asset;
+    asset.contentHash = ContentHash(compressedData);
+    asset.minBound = glm::vec2{ bound.left(), bound.top() };
+    asset.maxBound = glm::vec2{ bound.right(), bound.bottom() };
+
+    QMutexLocker locker(&mutex);
+
+    auto it = contents.find(asset.contentHash);
+    if (it == contents.end()) {
+        std::shared_ptr<V3dModelCache::Entry> entry = V3dModelCache::Instance().Acquire(asset.contentHash, compressedData);
+        if (entry == nullptr) {
+            qCDebug(OkularPdfDebug) << "Ignoring RichMedia asset on page" << pageNumber << "that is not a V3D model";
+            return;
+        }
+
+        it = contents.emplace(asset.contentHash, Content{}).first;
+        it->second.entry = std::move(entry);
+    }
+    ++it->second.pendingPlacements;
+    it->second.entry->AddPlacements(1);
+
+    assets[pageNumber].push_back(asset);
+}
+
+void V3dAssetStore::ParseInBackground()
+{
+    QMutexLocker locker(&mutex);
+
+    std::map<int, std::vector<Asset>*> pages;
+    for (auto& [pageNumber, pageAssets] : assets) {
+        pages[pageNumber] = &pageAssets;
+    }
+
+    // The first page with models goes first so it becomes renderable as soon as its own models are done.
+    // The rest is scheduled largest first, which keeps the pool busy until the end
+    std::vector<Content*> firstPage;
+    std::vector<Content*> rest;
+    for (auto& [pageNumber, pageAssets] : pages) {
+        for (Asset& asset : *pageAssets) {
+            Content& content = contents.at(asset.contentHash);
+            if (content.state != State::Unparsed) {
+                continue;
+            }
+
+            // Marked now so contents used by several placements are only queued once
+            content.state = State::Parsing;
+            (pageNumber == pages.begin()->first ? firstPage : rest).push_back(&content);
+        }
+    }
+    std::stable_sort(rest.begin(), rest.end(), [](const Content* a, const Content* b) { return a->entry->Probe().uncompressedSize > b->entry->Probe().uncompressedSize; });
+
+    // Parsing ahead past the memory budget would only evict models parsed a moment earlier.
+    // Whatever does not fit is left to be parsed when its page is requested
+    V3dModelCache& cache = V3dModelCache::Instance();
+    if (cache.MemoryBudget() > 0) {
+        qint64 available = cache.MemoryBudget() - cache.ResidentBytes();
+        for (Content* content : firstPage) {
+            available -= content->entry->EstimatedSize();
+        }
+
+        auto fits = rest.begin();
+        for (; fits != rest.end() && (*fits)->entry->EstimatedSize() <= available; ++fits) {
+            available -= (*fits)->entry->EstimatedSize();
+        }
+        for (auto it = fits; it != rest.end(); ++it) {
+            (*it)->state = State::Unparsed;
+        }
+        rest.erase(fits, rest.end());
+    }
+    firstPage.insert(firstPage.end(), rest.begin(), rest.end());
+
+    for (Content* content : firstPage) {
+        std::packaged_task<bool()> task{ [entry = content->entry, diskCache = &diskCache]() {
+            // Another document may be parsing the same content already, then this waits for it
+            return entry->Parse(*diskCache);
+        } };
+
+        content->future = task.get_future();
+        content->task = std::make_shared<ParseTask>(std::move(task));
+
+        parsePool()->start(content->task.get());
+    }
+}
+
+bool V3dAssetStore::Resolve(Content& content)
+{
+    if (content.state == State::Ready || content.state == State::Failed) {
+        return content.state == State::Ready;
+    }
+
+    bool parsed;
+    if (content.state == State::Parsing) {
+        // Not picked up by a worker yet, do it here rather than wait behind other pages
+        if (parsePool()->tryTake(content.task.get())) {
+            content.task->run();
+        }
+        parsed = content.future.get();
+    } else {
+        content.state = State::Parsing;
+        parsed = content.entry->Parse(diskCache);
+    }
+
+    content.state = parsed ? State::Ready : State::Failed;
+    content.task.reset();
+
+    return parsed;
+}
+
+void V3dAssetStore::LoadPage(int pageNumber, const std::function<bool()>& shouldAbort, const std::function<void(std::unique_ptr<V3dModel>, int)>& modelLoaded)
+{
+    // Models are handed over in annotation order, the manager indexes them per page
+    while (!shouldAbort || !shouldAbort()) {
+        std::unique_ptr<V3dModel> model;
+        int remaining;
+
+        {
+            QMutexLocker locker(&mutex);
+
+            auto it = assets.find(pageNumber);
+            if (it == assets.end()) {
+                return;
+            }
+
+            auto next = std::find_if(it->second.begin(), it->second.end(), [](const Asset& asset) { return asset.state == State::Unparsed; });
+            if (next == it->second.end()) {
+                return;
+            }
+            Asset& asset = *next;
+
+            Content& content = contents.at(asset.contentHash);
+            model = Resolve(content) ? content.entry->TakePlacement(diskCache) : nullptr;
+
+            if (model != nullptr) {
+                model->minBound = asset.minBound;
+                model->maxBound = asset.maxBound;
+                asset.state = State::Ready;
+            } else {
+                qCWarning(OkularPdfDebug) << "Skipping V3D asset on page" << pageNumber;
+                content.entry->ReleasePlacements(1);
+                asset.state = State::Failed;
+            }
+            --content.pendingPlacements;
+
+            remaining = std::count_if(it->second.begin(), it->second.end(), [](const Asset& asset) { return asset.state == State::Unparsed; });
+        }
+
+        // Without the mutex, the callback renders and may take a while
+        modelLoaded(std::move(model), remaining);
+    }
+}
+
+int V3dAssetStore::PendingModels(int pageNumber) const
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = assets.find(pageNumber);
+    if (it == assets.end()) {
+        return 0;
+    }
+    return std::count_if(it->second.begin(), it->second.end(), [](const Asset& asset) { return asset.state == State::Unparsed; });
+}
+
+bool V3dAssetStore::Empty() const
+{
+    QMutexLocker locker(&mutex);
+    return assets.empty();
+}
+
+void V3dAssetStore::Clear()
+{
+    QMutexLocker locker(&mutex);
+
+    // The pool is shared with other documents, so only this store's tasks are withdrawn or waited for.
+    // Running tasks finish their current model
+    for (auto& [contentHash, content] : contents) {
+        if (content.task != nullptr && !parsePool()->tryTake(content.task.get())) {
+            content.future.wait();
+        }
+        content.entry->ReleasePlacements(content.pendingPlacements);
+    }
+
+    assets.clear();
+    contents.clear();
+}
@@ -0,0 +1,98 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef OKULAR_V3DASSETSTORE_H
+#define OKULAR_V3DASSETSTORE_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QRectF>
+#include <QRunnable>
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "V3dModelManager.h"
+#include "v3ddiskcache.h"
+#include "v3dmodelcache.h"
+
+/**
+ * Keeps track of the V3D assets embedded in a document.
+ *
+ * At document open only the page, the annotation bounds and the compressed
+ * asset bytes are recorded. Assets are content addressed through the process
+ * wide V3dModelCache: placements whose compressed bytes are identical, in this
+ * or any other open document, share a single parse. Parsing into a V3dModel
+ * either happens on a worker pool shared by all documents (see
+ * ParseInBackground()) or, at the latest, the first time a pixmap of a page
+ * that uses the content is requested.
+ */
+class V3dAssetStore
+{
+public:
+    enum class State { Unparsed, Parsing, Ready, Failed };
+
+    // A placement of some content on a page
+    struct Asset {
+        std::string contentHash;
+        glm::vec2 minBound;
+        glm::vec2 maxBound;
+        // Ready once the placement has been handed to the model manager
+        State state{ State::Unparsed };
+    };
+
+    // This document's use of a shared content
+    struct Content {
+        std::shared_ptr<V3dModelCache::Entry> entry;
+        State state{ State::Unparsed };
+        // Placements in this document not handed to the model manager yet
+        int pendingPlacements{ 0 };
+
+        // Valid while state is Parsing
+        std::shared_ptr<QRunnable> task;
+        std::future<bool> future;
+    };
+
+    ~V3dAssetStore();
+
+    static std::string ContentHash(const QByteArray& compressedData);
+
+    // Size limit of the on-disk cache of inflated assets, 0 disables it
+    void SetDiskCacheSize(qint64 bytes);
+
+    // Records an asset, bound is the normalized annotation boundary. Assets that are not V3D models are ignored
+    void AddAsset(int pageNumber, const QByteArray& compressedData, const QRectF& bound);
+
+    // Queues the unparsed contents on the worker pool, those of the first page first.
+    // Beyond the first page only as many as fit the V3dModelCache memory budget are queued
+    void ParseInBackground();
+
+    // Hands the models of the page to modelLoaded one by one, parsing or waiting for them as needed.
+    // modelLoaded gets the model, nullptr if it could not be parsed, and the number still to come. It is
+    // called without the store's mutex held. Stops before the next model once shouldAbort returns true,
+    // the rest is loaded by a later call
+    void LoadPage(int pageNumber, const std::function<bool()>& shouldAbort, const std::function<void(std::unique_ptr<V3dModel>, int)>& modelLoaded);
+
+    // Number of models of the page not handed over by LoadPage yet
+    int PendingModels(int pageNumber) const;
+
+    bool Empty() const;
+    void Clear();
+
+private:
+    // Makes sure the content is parsed, returns false if it could not be
+    bool Resolve(Content& content);
+
+    mutable QMutex mutex;
+    std::unordered_map<int, std::vector<Asset>> assets;
+    std::unordered_map<std::string, Content> contents;
+
+    V3dDiskCache diskCache;
+};
+
+#endif // OKULAR_V3DASSETSTORE_H
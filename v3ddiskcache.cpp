@@ -0,0 +1,169 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "v3ddiskcache.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+
+#include <cstring>
+#include <stdexcept>
+
+#include "debug_pdf.h"
+#include "gzipixstream.h"
+
+namespace
+{
+// Magic and format version, both little-endian
+constexpr char entryMagic[4] = { 'V', '3', 'D', 'C' };
+constexpr qint64 headerSize = sizeof(entryMagic) + sizeof(quint32);
+
+QByteArray entryHeader()
+{
+    QByteArray header(entryMagic, sizeof(entryMagic));
+    const quint32 version = qToLittleEndian(V3dDiskCache::formatVersion);
+    header.append(reinterpret_cast<const char *>(&version), sizeof(version));
+    return header;
+}
+}
+
+V3dDiskCache::V3dDiskCache(const QString& directory)
+    : directory(directory)
+{
+}
+
+QString V3dDiskCache::DefaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/v3d");
+}
+
+void V3dDiskCache::SetMaxSize(qint64 bytes)
+{
+    maxSize = bytes;
+    Evict();
+}
+
+QString V3dDiskCache::EntryPath(const std::string& contentHash) const
+{
+    return directory + QLatin1Char('/') + QString::fromLatin1(QByteArray::fromStdString(contentHash).toHex()) + QStringLiteral(".v3dc");
+}
+
+bool V3dDiskCache::Stores(quint64 uncompressedSize) const
+{
+    // Storing an asset larger than the whole cache would only evict everything else, and then itself
+    return maxSize > 0 && uncompressedSize + headerSize <= static_cast<quint64>(maxSize);
+}
+
+std::unique_ptr<V3dModel> V3dDiskCache::Parse(const std::string& contentHash, const QByteArray& compressedData, quint64 uncompressedSize)
+{
+    if (!Stores(uncompressedSize)) {
+        xdr::gzipixstream xdrFile{ compressedData.constData(), static_cast<size_t>(compressedData.size()) };
+        std::unique_ptr<V3dModel> model = std::make_unique<V3dModel>(xdrFile, glm::vec2{}, glm::vec2{});
+
+        // A truncated asset can still yield a model, only inflating the rest tells
+        if (!xdrFile.drain()) {
+            throw std::runtime_error("Corrupt or truncated V3D asset");
+        }
+        return model;
+    }
+
+    const QString path = EntryPath(contentHash);
+
+    if (std::unique_ptr<V3dModel> model = ParseEntry(path)) {
+        return model;
+    }
+
+    std::unique_ptr<V3dModel> model = ParseAndStore(path, compressedData);
+    Evict();
+    return model;
+}
+
+std::unique_ptr<V3dModel> V3dDiskCache::ParseEntry(const QString& path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < headerSize) {
+        return nullptr;
+    }
+
+    uchar *data = file.map(0, file.size());
+    if (data == nullptr) {
+        return nullptr;
+    }
+
+    const QByteArray header = entryHeader();
+    if (std::memcmp(data, header.constData(), headerSize) != 0) {
+        qCDebug(OkularPdfDebug) << "Ignoring V3D cache entry with a different format" << path;
+        return nullptr;
+    }
+
+    // Mark the entry as recently used for eviction
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    try {
+        xdr::memixstream xdrFile{ reinterpret_cast<char *>(data + headerSize), static_cast<size_t>(file.size() - headerSize) };
+        return std::make_unique<V3dModel>(xdrFile, glm::vec2{}, glm::vec2{});
+    } catch (const std::exception& e) {
+        qCWarning(OkularPdfDebug) << "Discarding unreadable V3D cache entry" << path << ":" << e.what();
+        file.remove();
+        return nullptr;
+    }
+}
+
+std::unique_ptr<V3dModel> V3dDiskCache::ParseAndStore(const QString& path, const QByteArray& compressedData)
+{
+    QDir().mkpath(directory);
+
+    // Written to a temporary file and only renamed into place once the whole stream parsed
+    QSaveFile file(path);
+    const bool cacheable = file.open(QIODevice::WriteOnly) && file.write(entryHeader()) == headerSize;
+
+    xdr::gzipixstream xdrFile{ compressedData.constData(), static_cast<size_t>(compressedData.size()), cacheable ? &file : nullptr };
+    std::unique_ptr<V3dModel> model = std::make_unique<V3dModel>(xdrFile, glm::vec2{}, glm::vec2{});
+
+    // Inflating the rest also fills the entry. The entry is discarded along with the model on corrupt input
+    const bool drained = xdrFile.drain();
+    if (xdrFile.bad()) {
+        throw std::runtime_error("Corrupt or truncated V3D asset");
+    }
+
+    if (!cacheable) {
+        return model;
+    }
+
+    // The gzip trailer may understate the size, e.g. for assets past 4 GiB
+    if (file.pos() > maxSize) {
+        qCDebug(OkularPdfDebug) << "Not caching V3D asset larger than the cache" << path;
+        file.cancelWriting();
+    } else if (!drained || !file.commit()) {
+        qCDebug(OkularPdfDebug) << "Could not write V3D cache entry" << path;
+    }
+
+    return model;
+}
+
+void V3dDiskCache::Evict()
+{
+    QMutexLocker locker(&evictionMutex);
+
+    QDir cacheDir(directory);
+    const QFileInfoList entries = cacheDir.entryInfoList({ QStringLiteral("*.v3dc") }, QDir::Files, QDir::Time);
+
+    qint64 totalSize = 0;
+    for (const QFileInfo& entry : entries) {
+        totalSize += entry.size();
+    }
+
+    // Most recently used first, so drop from the back
+    for (auto it = entries.crbegin(); it != entries.crend() && totalSize > maxSize; ++it) {
+        if (QFile::remove(it->filePath())) {
+            totalSize -= it->size();
+        }
+    }
+}
@@ -0,0 +1,59 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef OKULAR_V3DDISKCACHE_H
+#define OKULAR_V3DDISKCACHE_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "V3dModelManager.h"
+
+/**
+ * On-disk cache of inflated V3D assets, keyed by the hash of the compressed asset.
+ *
+ * Each entry is a small versioned header followed by the raw XDR stream. On a
+ * hit the entry is memory mapped and parsed in place, which skips inflating
+ * the asset again. Entries are evicted least recently used first once the
+ * cache grows past its size limit.
+ */
+class V3dDiskCache
+{
+public:
+    static constexpr quint32 formatVersion = 1;
+
+    explicit V3dDiskCache(const QString& directory = DefaultDirectory());
+
+    static QString DefaultDirectory();
+
+    // A limit of 0 disables the cache and removes its entries
+    void SetMaxSize(qint64 bytes);
+
+    // Whether an asset of this inflated size would be stored, 0 if unknown
+    bool Stores(quint64 uncompressedSize) const;
+
+    // Parses the asset, from the cache when possible, and stores the inflated stream on a miss.
+    // Assets whose inflated stream, uncompressedSize when known up front, would not fit the cache are not stored.
+    // The returned model has empty bounds, those belong to each placement. Throws if the asset is corrupt
+    std::unique_ptr<V3dModel> Parse(const std::string& contentHash, const QByteArray& compressedData, quint64 uncompressedSize = 0);
+
+    // Removes the least recently used entries until the cache fits its size limit
+    void Evict();
+
+private:
+    QString EntryPath(const std::string& contentHash) const;
+    std::unique_ptr<V3dModel> ParseEntry(const QString& path) const;
+    std::unique_ptr<V3dModel> ParseAndStore(const QString& path, const QByteArray& compressedData);
+
+    QString directory;
+    std::atomic<qint64> maxSize{ 0 };
+    QMutex evictionMutex;
+};
+
+#endif // OKULAR_V3DDISKCACHE_H
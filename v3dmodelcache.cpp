@@ -0,0 +1,189 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "v3dmodelcache.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "debug_pdf.h"
+
+V3dModelCache::Entry::~Entry()
+{
+    DropModelLocked();
+}
+
+const V3dProbe& V3dModelCache::Entry::Probe() const
+{
+    return probe;
+}
+
+qint64 V3dModelCache::Entry::EstimatedSize() const
+{
+    // The inflated stream size is a good proxy for the parsed geometry, without a gzip trailer guess
+    return probe.uncompressedSize > 0 ? static_cast<qint64>(probe.uncompressedSize) : 4 * static_cast<qint64>(compressedData.size());
+}
+
+bool V3dModelCache::Entry::Parse(V3dDiskCache& diskCache)
+{
+    QMutexLocker locker(&mutex);
+    return ParseLocked(diskCache);
+}
+
+void V3dModelCache::Entry::AddPlacements(int count)
+{
+    QMutexLocker locker(&mutex);
+    pendingPlacements += count;
+}
+
+void V3dModelCache::Entry::ReleasePlacements(int count)
+{
+    QMutexLocker locker(&mutex);
+
+    pendingPlacements -= count;
+    if (pendingPlacements <= 0) {
+        DropModelLocked();
+    }
+}
+
+std::unique_ptr<V3dModel> V3dModelCache::Entry::TakePlacement(V3dDiskCache& diskCache)
+{
+    QMutexLocker locker(&mutex);
+
+    if (!ParseLocked(diskCache)) {
+        return nullptr;
+    }
+
+    // The last placement takes the parsed model, the others get a copy. Keeping it past that
+    // would leave it resident twice, here and in the model manager
+    if (--pendingPlacements <= 0) {
+        std::unique_ptr<V3dModel> taken = std::move(model);
+        DropModelLocked();
+        return taken;
+    }
+    return std::make_unique<V3dModel>(*model);
+}
+
+bool V3dModelCache::Entry::ParseLocked(V3dDiskCache& diskCache)
+{
+    V3dModelCache& cache = V3dModelCache::Instance();
+    lastUsed = ++cache.useCounter;
+
+    if (model != nullptr) {
+        return true;
+    }
+    if (failed) {
+        return false;
+    }
+
+    try {
+        model = diskCache.Parse(contentHash, compressedData, probe.uncompressedSize);
+    } catch (const std::exception& e) {
+        qCWarning(OkularPdfDebug) << "Failed to parse V3D asset:" << e.what();
+        failed = true;
+        return false;
+    }
+
+    residentBytes = EstimatedSize();
+    cache.residentBytes += residentBytes;
+    cache.Trim(this);
+
+    return true;
+}
+
+void V3dModelCache::Entry::DropModelLocked()
+{
+    model.reset();
+    V3dModelCache::Instance().residentBytes -= residentBytes;
+    residentBytes = 0;
+}
+
+V3dModelCache& V3dModelCache::Instance()
+{
+    static V3dModelCache instance;
+    return instance;
+}
+
+std::shared_ptr<V3dModelCache::Entry> V3dModelCache::Acquire(const std::string& contentHash, const QByteArray& compressedData)
+{
+    QMutexLocker locker(&mutex);
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        it = it->second.expired() ? entries.erase(it) : std::next(it);
+    }
+
+    auto it = entries.find(contentHash);
+    std::shared_ptr<Entry> entry = it != entries.end() ? it->second.lock() : nullptr;
+    if (entry != nullptr) {
+        return entry;
+    }
+
+    // RichMedia annotations also carry video and Flash assets, leave those alone
+    const V3dProbe probe = V3dProbe::Probe(compressedData);
+    if (!probe.valid) {
+        return nullptr;
+    }
+
+    entry = std::make_shared<Entry>();
+    entry->contentHash = contentHash;
+    entry->probe = probe;
+    entry->compressedData = compressedData;
+    entries[contentHash] = entry;
+
+    return entry;
+}
+
+void V3dModelCache::SetMemoryBudget(qint64 bytes)
+{
+    memoryBudget = bytes;
+}
+
+qint64 V3dModelCache::MemoryBudget() const
+{
+    return memoryBudget;
+}
+
+qint64 V3dModelCache::ResidentBytes() const
+{
+    return residentBytes;
+}
+
+void V3dModelCache::Trim(const Entry* keep)
+{
+    const qint64 budget = memoryBudget;
+    if (budget <= 0 || residentBytes <= budget) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+
+    // Entries busy in another thread are skipped, they are about to be used anyway
+    std::vector<std::pair<quint64, std::shared_ptr<Entry>>> candidates;
+    for (const auto& [contentHash, weakEntry] : entries) {
+        std::shared_ptr<Entry> entry = weakEntry.lock();
+        if (entry == nullptr || entry.get() == keep || !entry->mutex.tryLock()) {
+            continue;
+        }
+        if (entry->model != nullptr) {
+            candidates.emplace_back(entry->lastUsed, entry);
+        }
+        entry->mutex.unlock();
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    for (const auto& [lastUsed, entry] : candidates) {
+        if (residentBytes <= budget) {
+            break;
+        }
+        if (entry->mutex.tryLock()) {
+            qCDebug(OkularPdfDebug) << "Evicting parsed V3D model to stay within the memory budget";
+            entry->DropModelLocked();
+            entry->mutex.unlock();
+        }
+    }
+}
@@ -0,0 +1,106 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef OKULAR_V3DMODELCACHE_H
+#define OKULAR_V3DMODELCACHE_H
+
+#include <QByteArray>
+#include <QMutex>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "V3dModelManager.h"
+#include "v3ddiskcache.h"
+#include "v3dprobe.h"
+
+/**
+ * Process wide registry of V3D contents, shared by every open document.
+ *
+ * Entries are keyed by the hash of the compressed asset and reference counted
+ * by the documents using them, so the same model opened in several documents
+ * is only parsed once. The entry lives until the last document referencing it
+ * is closed.
+ *
+ * The compressed bytes stay resident for the entry's lifetime. The parsed
+ * model is only kept while some document still has placements of it to hand
+ * to its model manager: the last of them takes the model, the others get a
+ * copy. A document that places the content later parses it again, from the
+ * disk cache when that is enabled. Past the memory budget the least recently
+ * used parsed models drop back to their compressed form and are parsed again
+ * when a page needs them.
+ */
+class V3dModelCache
+{
+public:
+    class Entry
+    {
+    public:
+        ~Entry();
+
+        const V3dProbe& Probe() const;
+        // Memory the parsed model is accounted for against the budget
+        qint64 EstimatedSize() const;
+
+        void AddPlacements(int count);
+        // For placements that will never be taken, e.g. when their document is closed
+        void ReleasePlacements(int count);
+
+        // Parses the content unless that already happened, blocks while another thread parses it.
+        // Returns false if the content could not be parsed
+        bool Parse(V3dDiskCache& diskCache);
+
+        // The model for one placement, without bounds, parsed again if it was evicted.
+        // nullptr if the content could not be parsed
+        std::unique_ptr<V3dModel> TakePlacement(V3dDiskCache& diskCache);
+
+    private:
+        friend class V3dModelCache;
+
+        // These expect the mutex to be held
+        bool ParseLocked(V3dDiskCache& diskCache);
+        void DropModelLocked();
+
+        QMutex mutex;
+        std::string contentHash;
+        V3dProbe probe;
+        QByteArray compressedData;
+        bool failed{ false };
+        int pendingPlacements{ 0 };
+
+        std::unique_ptr<V3dModel> model;
+        // Estimated size of model and when it was last used, for the memory budget
+        qint64 residentBytes{ 0 };
+        quint64 lastUsed{ 0 };
+    };
+
+    static V3dModelCache& Instance();
+
+    // Returns the shared entry for the asset, nullptr if the asset is not a V3D model
+    std::shared_ptr<Entry> Acquire(const std::string& contentHash, const QByteArray& compressedData);
+
+    // Budget for parsed models not yet handed to a model manager, 0 means unlimited.
+    // Models already handed over belong to their manager and are not counted
+    void SetMemoryBudget(qint64 bytes);
+    qint64 MemoryBudget() const;
+    // Estimated size of the parsed models still waiting to be handed over
+    qint64 ResidentBytes() const;
+
+private:
+    V3dModelCache() = default;
+
+    // Evicts least recently used parsed models, other than keep, until the budget is met
+    void Trim(const Entry* keep);
+
+    QMutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<Entry>> entries;
+
+    std::atomic<qint64> memoryBudget{ 0 };
+    std::atomic<qint64> residentBytes{ 0 };
+    std::atomic<quint64> useCounter{ 0 };
+};
+
+#endif // OKULAR_V3DMODELCACHE_H
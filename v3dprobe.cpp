@@ -0,0 +1,126 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "v3dprobe.h"
+
+#include <QtEndian>
+
+#include <zlib.h>
+
+#include <vector>
+
+namespace
+{
+// From the V3D format, see v3dtypes in Asymptote
+constexpr quint32 headerType = 5;
+
+// Far more than any writer emits, anything above is not a V3D stream
+constexpr quint32 maxVersion = 1024;
+constexpr quint32 maxHeaderCount = 1024;
+
+// The version, precision and header block fit well within this
+constexpr size_t prefixSize = 16 * 1024;
+
+class XdrReader
+{
+public:
+    XdrReader(const unsigned char* data, size_t size)
+        : data(data)
+        , size(size)
+    {
+    }
+
+    bool ReadUint(quint32& value)
+    {
+        if (size - position < sizeof(quint32)) {
+            return false;
+        }
+        value = qFromBigEndian<quint32>(data + position);
+        position += sizeof(quint32);
+        return true;
+    }
+
+    bool Skip(quint64 words)
+    {
+        if ((size - position) / sizeof(quint32) < words) {
+            return false;
+        }
+        position += words * sizeof(quint32);
+        return true;
+    }
+
+private:
+    const unsigned char* data;
+    size_t size;
+    size_t position{ 0 };
+};
+
+std::vector<unsigned char> inflatePrefix(const QByteArray& compressedData)
+{
+    std::vector<unsigned char> prefix(prefixSize);
+
+    z_stream stream{};
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressedData.constData()));
+    stream.avail_in = static_cast<uInt>(compressedData.size());
+    stream.next_out = prefix.data();
+    stream.avail_out = static_cast<uInt>(prefix.size());
+
+    // 15 window bits, +32 to detect gzip or zlib headers, the same as gzip::decompress
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+        return {};
+    }
+
+    int ret = Z_OK;
+    while (ret == Z_OK && stream.avail_out > 0) {
+        ret = inflate(&stream, Z_NO_FLUSH);
+    }
+    if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+        prefix.clear();
+    } else {
+        prefix.resize(stream.total_out);
+    }
+
+    inflateEnd(&stream);
+    return prefix;
+}
+}
+
+V3dProbe V3dProbe::Probe(const QByteArray& compressedData)
+{
+    V3dProbe probe;
+
+    // gzip streams end with the uncompressed size modulo 2^32
+    const auto* bytes = reinterpret_cast<const unsigned char*>(compressedData.constData());
+    if (compressedData.size() >= 18 && bytes[0] == 0x1f && bytes[1] == 0x8b) {
+        probe.uncompressedSize = qFromLittleEndian<quint32>(bytes + compressedData.size() - 4);
+    }
+
+    const std::vector<unsigned char> prefix = inflatePrefix(compressedData);
+    XdrReader reader(prefix.data(), prefix.size());
+
+    // Asymptote always writes the version, the precision and then the header block. Other RichMedia
+    // assets, video or Flash, are very unlikely to also have a well formed header block at that spot
+    quint32 version;
+    quint32 doublePrecision;
+    if (!reader.ReadUint(version) || !reader.ReadUint(doublePrecision) || version == 0 || version > maxVersion || doublePrecision > 1) {
+        return probe;
+    }
+
+    quint32 type;
+    quint32 headerCount;
+    if (!reader.ReadUint(type) || type != headerType || !reader.ReadUint(headerCount) || headerCount == 0 || headerCount > maxHeaderCount) {
+        return probe;
+    }
+
+    for (quint32 i = 0; i < headerCount; ++i) {
+        quint32 key;
+        quint32 words;
+        if (!reader.ReadUint(key) || !reader.ReadUint(words) || !reader.Skip(words)) {
+            return probe;
+        }
+    }
+
+    probe.valid = true;
+    return probe;
+}
@@ -0,0 +1,27 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef OKULAR_V3DPROBE_H
+#define OKULAR_V3DPROBE_H
+
+#include <QByteArray>
+
+/**
+ * What can be learned about a compressed V3D asset without parsing it.
+ *
+ * Only the start of the stream is inflated, to check for the version,
+ * precision and header block every V3D writer emits, and the uncompressed
+ * size comes from the gzip trailer.
+ */
+struct V3dProbe {
+    // Whether the asset looks like a V3D model. This is a heuristic on the first words of the stream
+    bool valid{ false };
+
+    // 0 if unknown, e.g. for zlib rather than gzip streams
+    quint64 uncompressedSize{ 0 };
+
+    static V3dProbe Probe(const QByteArray& compressedData);
+};
+
+#endif // OKULAR_V3DPROBE_H